@@ -0,0 +1,133 @@
+/*
+ * Background jobs runner checks for the environments of the jobs
+ *
+ * Builds environment blocks with jobEnv from a fixed parent's environment
+ * and checks the add, override and remove rules, that the last entry wins
+ * if a name is repeated and that the blocks are shared between the jobs.
+ * "make check" builds and runs it.
+ *
+ * Sources: https://github.com/zoquero/bgrunner/
+ *
+ * @since 20261019
+ * @author zoquero@gmail.com
+ */
+
+#include <stdio.h>        // fprintf
+#include <string.h>       // strncmp
+
+#include "../bgrunner.h"
+
+
+static int errors = 0;
+
+#define CHECK(cond) \
+  if(!(cond)) { \
+    fprintf(stderr, "FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+    errors++; \
+  }
+
+static char *parentEnvp[] = { "PATH=/usr/bin:/bin", "HOME=/root", "LANG=C", NULL };
+
+
+/**
+  * Value of a variable on an environment block
+  * @arg times where the number of entries with that name is returned
+  * @return the value of the last entry or NULL if there's no one
+  */
+static char *envGet(char **block, char *name, int *times) {
+  size_t len = strlen(name);
+  char  *value = NULL;
+
+  *times = 0;
+  for(int i = 0; block[i] != NULL; i++) {
+    if(strncmp(block[i], name, len) == 0 && block[i][len] == '=') {
+      value = block[i] + len + 1;
+      (*times)++;
+    }
+  }
+  return value;
+}
+
+
+/**
+  * Checks that a variable is on a block just once and with a value,
+  * or that it isn't if value is NULL
+  */
+static void checkVar(char **block, char *name, char *value) {
+  int   times;
+  char *got = envGet(block, name, &times);
+
+  if(value == NULL) {
+    CHECK(times == 0);
+    return;
+  }
+  CHECK(times == 1);
+  CHECK(got != NULL && strcmp(got, value) == 0);
+}
+
+
+int main() {
+  char **block;
+
+  // add and remove
+  block = jobEnv("FOO=bar -HOME", parentEnvp);
+  CHECK(block != NULL);
+  if(block != NULL) {
+    checkVar(block, "FOO",  "bar");
+    checkVar(block, "HOME", NULL);
+    checkVar(block, "PATH", "/usr/bin:/bin");
+    checkVar(block, "LANG", "C");
+  }
+
+  // override, the parent's entry is replaced
+  block = jobEnv("HOME=/tmp", parentEnvp);
+  CHECK(block != NULL);
+  if(block != NULL) {
+    checkVar(block, "HOME", "/tmp");
+    checkVar(block, "PATH", "/usr/bin:/bin");
+  }
+
+  // removing and setting the same name sets it
+  block = jobEnv("-LANG LANG=ca_ES.UTF-8", parentEnvp);
+  CHECK(block != NULL);
+  if(block != NULL)
+    checkVar(block, "LANG", "ca_ES.UTF-8");
+
+  // the last one wins if a name is repeated
+  block = jobEnv("A=1 B=2 A=3", parentEnvp);
+  CHECK(block != NULL);
+  if(block != NULL) {
+    checkVar(block, "A", "3");
+    checkVar(block, "B", "2");
+  }
+
+  // removing a variable that isn't on the parent's environment
+  block = jobEnv("-NOTSET", parentEnvp);
+  CHECK(block != NULL);
+  if(block != NULL) {
+    checkVar(block, "NOTSET", NULL);
+    checkVar(block, "HOME", "/root");
+  }
+
+  // wrong specs
+  CHECK(jobEnv("NOEQUALS", parentEnvp) == NULL);
+  CHECK(jobEnv("=value", parentEnvp) == NULL);
+  CHECK(jobEnv("-A=1", parentEnvp) == NULL);
+  CHECK(jobEnv("-", parentEnvp) == NULL);
+
+  // the same spec gets the same block, the same cwd the same string
+  CHECK(jobEnv("A=1 B=2 A=3", parentEnvp) == jobEnv("A=1 B=2 A=3", parentEnvp));
+  CHECK(jobEnv("FOO=bar -HOME", parentEnvp) != jobEnv("HOME=/tmp", parentEnvp));
+  CHECK(numJobEnvs() == 5);
+  CHECK(jobCwd("/tmp") == jobCwd("/tmp"));
+
+  freeJobEnvs();
+  CHECK(numJobEnvs() == 0);
+
+  if(errors != 0) {
+    fprintf(stderr, "%d environment checks failed\n", errors);
+    return 1;
+  }
+  printf("All the environment checks passed\n");
+  return 0;
+}
@@ -0,0 +1,100 @@
+#!/bin/bash
+
+##
+## Runs bgrunner in simulation mode (-s) with sim_check.csv and with
+## a descriptor of 100000 jobs and checks the results, also the binary
+## results file (-b) through "bgrunner report".
+## Usage: sim_check.sh <bgrunner>
+##
+
+DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+bgrunner=$1
+out=$(mktemp -d)
+trap 'rm -rf "$out"' EXIT
+errors=0
+
+# result <alias> <field>: field of the results row of a job
+#   3: wait_ret_code, 4: killedByTimeout, 5: execResult, 6: durationMS
+result() {
+  awk -F';' -v a="$1" -v f="$2" '$1 == a { print $f }' "$out/bgrunner.results.csv"
+}
+
+expect() {
+  local got=$(result "$1" "$2")
+  if [ "$got" != "$3" ]; then
+    echo "FAIL: job $1 field $2 is [$got], expected [$3]"
+    errors=$((errors+1))
+  fi
+}
+
+# prefix <prefix> <field>: field of the group of a prefix on the report
+#   2: jobs, 3: failures, 4: timeouts, 5: execErrors
+prefix() {
+  awk -v p="$1" -v f="$2" '/^By alias prefix/ { g = 1; next } /^$/ { g = 0 } g && $1 == p { print $f }' "$out/report"
+}
+
+expectPrefix() {
+  local got=$(prefix "$1" "$2")
+  if [ "$got" != "$3" ]; then
+    echo "FAIL: prefix $1 field $2 is [$got] on the report, expected [$3]"
+    errors=$((errors+1))
+  fi
+}
+
+if ! "$bgrunner" -s -b -o "$out" -f "$DIR/sim_check.csv" > "$out/log"; then
+  echo "FAIL: bgrunner -s -b -f $DIR/sim_check.csv"
+  exit 1
+fi
+expect ok             4 0
+expect ok             6 10.000000
+expect timeout        4 1
+expect timeout        6 52.000000
+expect fails          3 3
+expect fails          4 0
+expect fails          6 20.000000
+expect nonnumeric     5 2
+expect negative       5 2
+expect huge           5 2
+expect delayedtimeout 4 0
+expect delayedtimeout 6 30.000000
+expect edge           4 0
+
+# the binary results file has the same rows than the CSV one
+if ! "$bgrunner" report -p 3 -c "$out/report.csv" -i "$out/bgrunner.results.bin" > "$out/report"; then
+  echo "FAIL: bgrunner report -i $out/bgrunner.results.bin"
+  exit 1
+fi
+if ! diff <(sort "$out/report.csv") <(sort "$out/bgrunner.results.csv") > /dev/null; then
+  echo "FAIL: bgrunner report -c doesn't reproduce bgrunner.results.csv"
+  errors=$((errors+1))
+fi
+expectPrefix tim 2 1
+expectPrefix tim 4 1
+expectPrefix fai 3 1
+expectPrefix fai 4 0
+expectPrefix non 5 1
+expectPrefix del 4 0
+expectPrefix ok  2 1
+timeouts=$(awk '/^By alias prefix/ { g = 1; next } /^$/ { g = 0 } g && $1 != "#prefix" { t += $4 } END { print t }' "$out/report")
+if [ "$timeouts" != 1 ]; then
+  echo "FAIL: $timeouts timeouts on the report, expected 1"
+  errors=$((errors+1))
+fi
+
+# 100000 jobs, every one must be in the results exactly once
+awk 'BEGIN { for(i = 0; i < 100000; i++) printf "j%d;%d;%d;%d\n", i, i % 10, i % 3 ? 0 : 50, i % 100 }' > "$out/big.csv"
+if ! "$bgrunner" -s -o "$out" -f "$out/big.csv" > "$out/log"; then
+  echo "FAIL: bgrunner -s with 100000 jobs"
+  exit 1
+fi
+got=$(grep -v '^#' "$out/bgrunner.results.csv" | cut -d';' -f1 | sort | uniq -c | awk '$1 == 1' | wc -l)
+if [ "$got" -ne 100000 ]; then
+  echo "FAIL: $got of the 100000 jobs are in the results exactly once"
+  errors=$((errors+1))
+fi
+
+if [ $errors -ne 0 ]; then
+  echo "$errors checks failed"
+  exit 1
+fi
+echo "All the simulation checks passed"
@@ -21,12 +21,13 @@
 void usage() {
   printf("Background jobs runner\n");
   printf("Usage:\n");
-  printf("bgrunner (-v) (-d) (-o <outputfolder>) -f <jobsdescriptor>\n");
+  printf("bgrunner (-v) (-d) (-b) (-s) (-m <metricsfile>) (-o <outputfolder>) -f <jobsdescriptor>\n");
+  printf("bgrunner report (-p <prefixlength>) (-n <topn>) (-c <csvfile>) -i <binaryresults>\n");
   exit(1);
 }
 
 
-void getOpts(int argc, char **argv, int *verbose, char *filename, char *outputFolder) {
+void getOpts(int argc, char **argv, int *verbose, int *binaryResults, int *simulation, char *metricsFile, char *filename, char *outputFolder) {
   int c;
   extern char *optarg;
   extern int optind, opterr, optopt;
@@ -44,7 +45,7 @@ void getOpts(int argc, char **argv, int *verbose, char *filename, char *outputFo
 
   char scanfFormat[20];
   sprintf(scanfFormat, "%%%ds", PATH_MAX - 1);
-  while ((c = getopt (argc, argv, "vdo:f:")) != -1) {
+  while ((c = getopt (argc, argv, "vdbsm:o:f:")) != -1) {
     switch (c) {
       case 'h':
         usage();
@@ -55,6 +56,18 @@ void getOpts(int argc, char **argv, int *verbose, char *filename, char *outputFo
       case 'd':
         d = 1;
         break;
+      case 'b':
+        *binaryResults = 1;
+        break;
+      case 's':
+        *simulation = 1;
+        break;
+      case 'm':
+        if(sscanf(optarg, scanfFormat, metricsFile) != 1) {
+          fprintf (stderr, "Option -%c requires an argument\n", c);
+          usage();
+        }
+        break;
       case 'o':
         if(sscanf(optarg, scanfFormat, outputFolder) != 1) {
           fprintf (stderr, "Option -%c requires an argument\n", c);
@@ -88,6 +101,64 @@ void getOpts(int argc, char **argv, int *verbose, char *filename, char *outputFo
   }
 }
 
+/**
+  * The report subcommand: aggregates over a binary results file.
+  * @return exit code
+  */
+int report(int argc, char **argv) {
+  int c;
+  extern char *optarg;
+  extern int opterr, optopt;
+  opterr = 0;
+  char filename[PATH_MAX];
+  char csvFilename[PATH_MAX];
+  unsigned int prefixLen = REPORT_DEFAULT_PREFIX_LEN;
+  unsigned int topN = REPORT_DEFAULT_TOP_N;
+  short i = 0, csv = 0;
+
+  char scanfFormat[20];
+  sprintf(scanfFormat, "%%%ds", PATH_MAX - 1);
+  while ((c = getopt (argc, argv, "p:n:c:i:")) != -1) {
+    switch (c) {
+      case 'p':
+        if(sscanf(optarg, "%u", &prefixLen) != 1) {
+          fprintf (stderr, "Option -%c requires a number\n", c);
+          usage();
+        }
+        break;
+      case 'n':
+        if(sscanf(optarg, "%u", &topN) != 1) {
+          fprintf (stderr, "Option -%c requires a number\n", c);
+          usage();
+        }
+        break;
+      case 'c':
+        if(sscanf(optarg, scanfFormat, csvFilename) != 1) {
+          fprintf (stderr, "Option -%c requires an argument\n", c);
+          usage();
+        }
+        csv = 1;
+        break;
+      case 'i':
+        if(sscanf(optarg, scanfFormat, filename) != 1) {
+          fprintf (stderr, "Option -%c requires an argument\n", c);
+          usage();
+        }
+        i = 1;
+        break;
+      default:
+        fprintf (stderr, "Wrong arguments for the report subcommand\n");
+        usage();
+    }
+  }
+  if(!i) {
+    fprintf(stderr, "Missing the binary results file\n");
+    usage();
+  }
+
+  return reportResults(filename, prefixLen, topN, csv ? csvFilename : NULL);
+}
+
 /**
   * Main.
   *
@@ -103,10 +174,16 @@ int main (int argc, char *argv[], char *envp[]) {
    * 2 == more verbose (-d)
    */
   int  verbose = 0;
+  int  binaryResults = 0;
+  int  simulation = 0;
   char filename[PATH_MAX];
   char outputFolder[PATH_MAX];
+  char metricsFile[PATH_MAX] = "";
 
-  getOpts(argc, argv, &verbose, filename, outputFolder);
+  if(argc > 1 && strcmp(argv[1], "report") == 0)
+    exit(report(argc - 1, argv + 1));
+
+  getOpts(argc, argv, &verbose, &binaryResults, &simulation, metricsFile, filename, outputFolder);
 
   if(verbose > 1)
     printf("Parameters set on build time:\n"
@@ -117,11 +194,17 @@ int main (int argc, char *argv[], char *envp[]) {
            "DEFAULT_FOLDER=[%s]\n"
            "SLEEP_TIME_US=[%d]\n"
            "US_TO_SHOW_ON_DEBUG=[%d]\n"
+           "METRICS_INTERVAL_US=[%d]\n"
            "RESULTS_BASENAME=[%s]\n", 
            MAX_JOBS, BUFSIZE, MAX_ARGS, MAX_ALIAS_LEN, DEFAULT_FOLDER, 
-           SLEEP_TIME_US, US_TO_SHOW_ON_DEBUG, RESULTS_BASENAME);
+           SLEEP_TIME_US, US_TO_SHOW_ON_DEBUG, METRICS_INTERVAL_US,
+           RESULTS_BASENAME);
+
+  if(simulation)
+    simulate();
 
-  launchJobs(filename, outputFolder, envp, verbose);
+  launchJobs(filename, outputFolder, envp, verbose, binaryResults,
+             *metricsFile != '\0' ? metricsFile : NULL);
 
   exit(0);
 }
@@ -8,21 +8,40 @@
 #ifndef BGRUNNER_H
 #define BGRUNNER_H
 
+#include <stdio.h>        // FILE
 #include <sys/types.h>    // pid_t
 #include <unistd.h>       // pid_t
 #include <limits.h>       // PATH_MAX
+#include <stdint.h>       // uint32_t, uint64_t
+#include <regex.h>        // regex_t
+#include <sys/time.h>     // struct timeval
 
 #define MAX_JOBS 1024
 #define BUFSIZE  1024
 #define MAX_ARGS  100
 #define MAX_ALIAS_LEN       50      // Max length of the alias
+// aprox 10 characters per param and per env variable,
+// 50 for separators and miliseconds, PATH_MAX more for the working directory
+#define MAX_LINE_LEN        (MAX_ALIAS_LEN+2*PATH_MAX+20*MAX_ARGS+50)
+// alias;startAfterMS;maxDurationMS;command(;env(;cwd)), env and cwd are optional
+#define JOB_REGEX           "([^;]+);([^;]+);([^;]+);([^;]+)(;([^;]*)(;([^;]*))?)?"
+#define JOB_REGEX_GROUPS    9
 #define STATE_PREFORK       0
 #define STATE_FORKED        1
 #define STATE_EXEC_ERROR    2
 #define DEFAULT_FOLDER      "/tmp"
 #define SLEEP_TIME_US       1000    // in microseconds
 #define US_TO_SHOW_ON_DEBUG 1000000 // 1 second
+#define METRICS_INTERVAL_US 1000000 // 1 second between writes of the metrics file
+#define METRICS_BUFSIZE     8192
 #define RESULTS_BASENAME    "bgrunner.results.csv"
+#define BIN_RESULTS_BASENAME "bgrunner.results.bin"
+#define BIN_RESULTS_MAGIC   "BGRRES\0"
+#define BIN_RESULTS_VERSION 1
+#define EXEC_RESULT_OK      1       // execResult column values
+#define EXEC_RESULT_ERROR   2
+#define REPORT_DEFAULT_PREFIX_LEN 3 // Alias prefix length to group by
+#define REPORT_DEFAULT_TOP_N      10
 
 enum bgjstate {UNSTARTED, STARTED, KILLED, FINISHED}; 
 
@@ -36,22 +55,104 @@ typedef struct {
   pid_t          pid;
   enum bgjstate  state;
   struct timeval startupTime;
-  char        ** envp;
+  char        ** envp;         // shared between jobs with the same env spec
+  char         * cwd;          // shared too, NULL to inherit the parent's one
   int            verbose;
 } bgjob;
 
+/**
+ * Header of the binary results file.
+ *
+ * The file is laid out to be mmap'd: this header, then one fixed-width
+ * column per field with a row per finished job (in finishing order),
+ * then the offsets of the alias and command of each job (indexed by job id)
+ * on the string table, and the string table itself (NUL-terminated strings).
+ */
+typedef struct {
+  char           magic[8];
+  uint32_t       version;
+  uint32_t       numJobs;      // capacity of every column
+  uint32_t       numRecords;   // rows already written
+  uint32_t       sleepTimeUS;
+  uint64_t       strTableSize;
+  char           reserved[32]; // keeps the columns 8 bytes aligned
+} bgresheader;
+
+/** A binary results file mapped on memory */
+typedef struct {
+  int            fd;
+  char         * map;
+  size_t         size;
+  bgresheader  * header;
+  double       * durationMS;   // columns, one row per finished job
+  uint32_t     * jobId;
+  int32_t      * retCode;
+  uint8_t      * killed;
+  uint8_t      * execResult;
+  uint32_t     * aliasOff;     // indexed by job id
+  uint32_t     * commandOff;   // indexed by job id
+  char         * strTable;
+} bgresults;
+
+/** Timer of a min-heap of timers */
+typedef struct {
+  double         atMS;
+  unsigned int   id;
+} bgtimer;
+
+/** Min-heap of timers */
+typedef struct {
+  bgtimer      * items;
+  unsigned int   size;
+  unsigned int   cap;
+} bgtimers;
+
+/**
+ * Process operations used to launch and wait for the jobs,
+ * the real ones or the ones of the simulation mode.
+ */
+typedef struct {
+  void  (*launch)(void *, char *, char *);  // like launchJob
+  pid_t (*reap)(pid_t, int *);               // like waitpid(, , WNOHANG)
+  int   (*kill)(pid_t);                      // kills with SIGKILL
+  void  (*now)(struct timeval *);
+  void  (*sleep)(unsigned int);              // like usleep
+} bgprocops;
+
 /* Funcs */
 
 unsigned int countLines(char *);
+int compileJobRegex(regex_t *);
+int parseJobLine(regex_t *, char *, bgjob *, char *envp[], int, char **);
+int readJobs(FILE *, regex_t *, bgjob *, unsigned int, unsigned int *, char *envp[], int, char *, char **);
 bgjob *loadJobs(char *, unsigned int*, char *envp[], int);
-void launchJobs(char *, char *, char *envp[], int);
+void launchJobs(char *, char *, char *envp[], int, int, char *);
 void launchJob(void *, char *, char *);
-void waitForJobs(bgjob *, char *, unsigned int, int);
+void waitForJobs(bgjob *, char *, unsigned int, int, int);
 int split(char *, char **, char *, int);
+unsigned int hashString(char *, size_t);
 void tPrint (char *);
 double timeval_diff(struct timeval *, struct timeval *);
+void setProcOps(bgprocops *);
+void clockNow(struct timeval *);
+void timerPush(bgtimers *, double, unsigned int);
+bgtimer timerPop(bgtimers *);
 void printJobShort(bgjob *);
 void printJob(bgjob *);
 void printJobFull(bgjob *);
+int openBinResults(bgresults *, char *, bgjob *, unsigned int, unsigned int);
+void addBinResult(bgresults *, unsigned int, int, short, char, double);
+int closeBinResults(bgresults *);
+int loadBinResults(bgresults *, char *);
+int reportResults(char *, unsigned int, unsigned int, char *);
+void metricsInit(char *);
+void metricsLaunch(double);
+void metricsFinished(double, short, char, int);
+void metricsTick(bgjob *, unsigned int, int);
+char **jobEnv(char *, char *envp[]);
+char *jobCwd(char *);
+unsigned int numJobEnvs();
+void freeJobEnvs();
+void simulate();
 
 #endif // BGRUNNER_H
@@ -0,0 +1,221 @@
+/*
+ * Background jobs runner per-job environments and working directories
+ *
+ * The environment and working directory of each job are built once when
+ * loading the descriptor and shared between all the jobs that describe
+ * the same ones, so a million jobs with a handful of distinct environments
+ * just keep a handful of environment blocks. The entries not modified
+ * by the job point to the strings of the parent's environment.
+ *
+ * Sources: https://github.com/zoquero/bgrunner/
+ *
+ * @since 20261019
+ * @author zoquero@gmail.com
+ */
+
+#include <stdio.h>        // fprintf
+#include <stdlib.h>       // malloc, exit
+#include <string.h>       // strcmp, strdup
+
+#include "bgrunner.h"
+
+
+/** Entry of a table of interned values, key is the spec on the descriptor */
+typedef struct {
+  char         * key;
+  void         * value;
+  char         * storage;      // strings the value points to, if any
+} bginterned;
+
+/** Open addressing hash table of interned values */
+typedef struct {
+  bginterned   * entries;
+  unsigned int   cap;
+  unsigned int   used;
+} bginterntable;
+
+static bginterntable envBlocks;
+static bginterntable cwds;
+
+
+/**
+  * Finds the slot of a key, growing the table if needed
+  * @return the slot, with a NULL key if the key isn't on the table yet
+  */
+static bginterned *internSlot(bginterntable *t, char *key) {
+  unsigned int h;
+
+  if(2 * (t->used + 1) > t->cap) {
+    bginterntable old = *t;
+    t->cap     = old.cap ? 2 * old.cap : 16;
+    t->entries = calloc(t->cap, sizeof(bginterned));
+    if(t->entries == NULL) {
+      fprintf(stderr, "Can't allocate memory for the environments of the jobs\n");
+      exit(1);
+    }
+    for(unsigned int i = 0; i < old.cap; i++) {
+      if(old.entries[i].key == NULL)
+        continue;
+      for(h = hashString(old.entries[i].key, strlen(old.entries[i].key)) & (t->cap - 1);
+          t->entries[h].key != NULL; h = (h + 1) & (t->cap - 1));
+      t->entries[h] = old.entries[i];
+    }
+    free(old.entries);
+  }
+
+  for(h = hashString(key, strlen(key)) & (t->cap - 1); ; h = (h + 1) & (t->cap - 1))
+    if(t->entries[h].key == NULL || strcmp(t->entries[h].key, key) == 0)
+      return t->entries + h;
+}
+
+
+static void internSet(bginterntable *t, bginterned *slot, char *key, void *value, char *storage) {
+  slot->key = strdup(key);
+  if(slot->key == NULL) {
+    fprintf(stderr, "Can't allocate memory for the environments of the jobs\n");
+    exit(1);
+  }
+  slot->value   = value;
+  slot->storage = storage;
+  t->used++;
+}
+
+
+/**
+  * Length of the name of an environment entry (NAME=value)
+  */
+static size_t envNameLen(char *entry) {
+  char *eq = strchr(entry, '=');
+  return eq == NULL ? strlen(entry) : eq - entry;
+}
+
+
+/**
+  * Builds a new environment block from the parent's one and a spec
+  * @arg storage where the copy of the spec the additions point to is returned
+  * @return the block or NULL if the spec can't be parsed
+  */
+static char **buildEnvBlock(char *spec, char *envp[], char **storage) {
+  char *tokens[MAX_ARGS + 1];
+  char *specCopy;
+  char **block;
+  int   numTokens;
+  int   numParent = 0;
+  int   n = 0;
+
+  // the additions point to specCopy, that lives as long as the block
+  specCopy = strdup(spec);
+  if(specCopy == NULL) {
+    fprintf(stderr, "Can't allocate memory for the environments of the jobs\n");
+    exit(1);
+  }
+  numTokens = split(specCopy, tokens, " ", MAX_ARGS);
+  if(numTokens == -1) {
+    free(specCopy);
+    return NULL;
+  }
+  for(int t = 0; t < numTokens; t++) {
+    char *name = *tokens[t] == '-' ? tokens[t] + 1 : tokens[t];
+    if(envNameLen(name) == 0
+        || (*tokens[t] == '-' && strchr(name, '=') != NULL)
+        || (*tokens[t] != '-' && strchr(name, '=') == NULL)) {
+      free(specCopy);
+      return NULL;
+    }
+  }
+
+  while(envp[numParent] != NULL)
+    numParent++;
+  block = malloc((numParent + numTokens + 1) * sizeof(char *));
+  if(block == NULL) {
+    fprintf(stderr, "Can't allocate memory for the environments of the jobs\n");
+    exit(1);
+  }
+
+  // inherited entries that aren't removed nor overridden
+  for(int i = 0; i < numParent; i++) {
+    size_t len = envNameLen(envp[i]);
+    int    keep = 1;
+    for(int t = 0; t < numTokens && keep; t++) {
+      char *name = *tokens[t] == '-' ? tokens[t] + 1 : tokens[t];
+      if(envNameLen(name) == len && strncmp(name, envp[i], len) == 0)
+        keep = 0;
+    }
+    if(keep)
+      block[n++] = envp[i];
+  }
+  // additions, the last one wins if a name is repeated
+  for(int t = 0; t < numTokens; t++) {
+    if(*tokens[t] == '-')
+      continue;
+    size_t len = envNameLen(tokens[t]);
+    int    last = 1;
+    for(int u = t + 1; u < numTokens && last; u++)
+      if(*tokens[u] != '-' && envNameLen(tokens[u]) == len && strncmp(tokens[u], tokens[t], len) == 0)
+        last = 0;
+    if(last)
+      block[n++] = tokens[t];
+  }
+  block[n] = NULL;
+  *storage = specCopy;
+  return block;
+}
+
+
+/**
+  * Environment for a job, shared with the other jobs with the same spec
+  * @arg spec space separated list of NAME=value to add or override
+  *           and -NAME to remove variables from the parent's environment
+  * @arg envp parent's environment
+  * @return the environment block or NULL if the spec can't be parsed
+  */
+char **jobEnv(char *spec, char *envp[]) {
+  bginterned *slot = internSlot(&envBlocks, spec);
+  char **block;
+  char  *storage;
+
+  if(slot->key != NULL)
+    return (char **) slot->value;
+  block = buildEnvBlock(spec, envp, &storage);
+  if(block != NULL)
+    internSet(&envBlocks, slot, spec, block, storage);
+  return block;
+}
+
+
+/**
+  * Working directory for a job, shared with the other jobs with the same one
+  */
+char *jobCwd(char *cwd) {
+  bginterned *slot = internSlot(&cwds, cwd);
+
+  if(slot->key == NULL)
+    internSet(&cwds, slot, cwd, NULL, NULL);
+  return slot->key;
+}
+
+
+/**
+  * Number of distinct environment blocks built
+  */
+unsigned int numJobEnvs() {
+  return envBlocks.used;
+}
+
+
+/**
+  * Frees the environment blocks and working directories
+  */
+void freeJobEnvs() {
+  for(unsigned int i = 0; i < envBlocks.cap; i++) {
+    free(envBlocks.entries[i].key);
+    free(envBlocks.entries[i].value);
+    free(envBlocks.entries[i].storage);
+  }
+  for(unsigned int i = 0; i < cwds.cap; i++)
+    free(cwds.entries[i].key);
+  free(envBlocks.entries);
+  free(cwds.entries);
+  memset(&envBlocks, 0, sizeof(envBlocks));
+  memset(&cwds, 0, sizeof(cwds));
+}
@@ -53,6 +53,20 @@ int split(char *string, char **splitted_string, char *delim, int max_components)
 }
 
 
+/**
+  * FNV-1a hash of the first chars of a string, for the hash tables
+  * @arg s string
+  * @arg len number of chars to hash
+  * @return the hash
+  */
+unsigned int hashString(char *s, size_t len) {
+  unsigned int h = 2166136261u;
+  for(size_t i = 0; i < len; i++)
+    h = (h ^ (unsigned char) s[i]) * 16777619u;
+  return h;
+}
+
+
 /**
   * Print to stdout with UTC timestamp
   * @arg s string to write
@@ -86,7 +100,101 @@ double timeval_diff(struct timeval *a, struct timeval *b) {
 }
 
 
-void waitForJobs(bgjob *jobs, char *outputFolder, unsigned int numJobs, int verbose) {
+/*
+ * Real process operations. The simulated ones are on bgrunnersim.c
+ */
+static pid_t realReap(pid_t pid, int *status) {
+  return waitpid(pid, status, WNOHANG);
+}
+
+static int realKill(pid_t pid) {
+  return kill(pid, SIGKILL);
+}
+
+static void realNow(struct timeval *now) {
+  gettimeofday(now, NULL);
+}
+
+static void realSleep(unsigned int us) {
+  usleep(us);
+}
+
+static bgprocops realOps = { launchJob, realReap, realKill, realNow, realSleep };
+static bgprocops *procOps = &realOps;
+
+
+/**
+  * Replaces the process operations used to launch and wait for the jobs
+  */
+void setProcOps(bgprocops *ops) {
+  procOps = ops;
+}
+
+
+/**
+  * Current time, from the simulated clock when simulating
+  */
+void clockNow(struct timeval *now) {
+  procOps->now(now);
+}
+
+
+static int timerBefore(bgtimer *a, bgtimer *b) {
+  return a->atMS < b->atMS || (a->atMS == b->atMS && a->id < b->id);
+}
+
+
+/**
+  * Adds a timer to a min-heap of timers, ordered by time and then by id
+  */
+void timerPush(bgtimers *t, double atMS, unsigned int id) {
+  unsigned int i = t->size++;
+
+  if(t->size > t->cap) {
+    t->cap   = t->cap ? 2 * t->cap : 64;
+    t->items = realloc(t->items, t->cap * sizeof(bgtimer));
+    if(t->items == NULL) {
+      fprintf(stderr, "Can't allocate memory for the timers\n");
+      exit(1);
+    }
+  }
+  t->items[i].atMS = atMS;
+  t->items[i].id   = id;
+  while(i > 0 && timerBefore(t->items + i, t->items + (i - 1) / 2)) {
+    bgtimer tmp = t->items[i];
+    t->items[i] = t->items[(i - 1) / 2];
+    t->items[(i - 1) / 2] = tmp;
+    i = (i - 1) / 2;
+  }
+}
+
+
+/**
+  * Removes and returns the first timer of a non empty min-heap of timers
+  */
+bgtimer timerPop(bgtimers *t) {
+  bgtimer first = t->items[0];
+  unsigned int i = 0;
+
+  t->items[0] = t->items[--t->size];
+  for(;;) {
+    unsigned int l = 2 * i + 1, r = l + 1, m = i;
+    if(l < t->size && timerBefore(t->items + l, t->items + m))
+      m = l;
+    if(r < t->size && timerBefore(t->items + r, t->items + m))
+      m = r;
+    if(m == i)
+      break;
+    bgtimer tmp = t->items[i];
+    t->items[i] = t->items[m];
+    t->items[m] = tmp;
+    i = m;
+  }
+  return first;
+}
+
+
+void waitForJobs(bgjob *jobs, char *outputFolder, unsigned int numJobs, int verbose, int binaryResults) {
   int finishedJobs;
   pid_t w;
   int status;
@@ -95,7 +203,15 @@ void waitForJobs(bgjob *jobs, char *outputFolder, unsigned int numJobs, int verb
   char MSGBUFF[BUFSIZE];
   char wExitStatus;
   char outputFilename[PATH_MAX];
-  short killed[numJobs];
+  char binOutputFilename[PATH_MAX];
+  short *killed;
+  bgresults binResults;
+
+  killed = calloc(numJobs, sizeof(short));
+  if(killed == NULL) {
+    fprintf(stderr, "Can't allocate memory to keep track of the jobs\n");
+    exit(1);
+  }
 
   sprintf(outputFilename, "%s/%s", outputFolder, RESULTS_BASENAME);
 
@@ -115,6 +231,16 @@ void waitForJobs(bgjob *jobs, char *outputFolder, unsigned int numJobs, int verb
     fprintf(resultsFile, "#job_alias;job_command;wait_ret_code;killedByTimeout(0==false,1==true);execResult(1==ok,2==error);durationMS(sleepTime=%dus)\n",sleepTime);
   }
 
+  if(binaryResults) {
+    sprintf(binOutputFilename, "%s/%s", outputFolder, BIN_RESULTS_BASENAME);
+    if(openBinResults(&binResults, binOutputFilename, jobs, numJobs, sleepTime) != 0) {
+      snprintf(MSGBUFF, sizeof(MSGBUFF), "ERROR: Can't open the binary results file %s", binOutputFilename);
+      tPrint(MSGBUFF);
+      fflush(stdout);
+      binaryResults = 0;
+    }
+  }
+
   if(verbose) {
     sprintf(MSGBUFF, "Let's wait for the jobs with a sleepTime of [%u] us", sleepTime);
     tPrint(MSGBUFF);
@@ -124,10 +250,11 @@ void waitForJobs(bgjob *jobs, char *outputFolder, unsigned int numJobs, int verb
     finishedJobs = 0;
     for(int i = 0; i < numJobs; i++) {
       if(jobs[i].state == STARTED) {
-        w = waitpid(jobs[i].pid, &status, WNOHANG);
+        w = procOps->reap(jobs[i].pid, &status);
         if(w == jobs[i].pid) {
           jobs[i].state = FINISHED;
           finishedJobs++;
+          wExitStatus = 0;
           if(WIFEXITED(status)) {
             wExitStatus = WEXITSTATUS(status);
             if(verbose) {
@@ -156,9 +283,13 @@ void waitForJobs(bgjob *jobs, char *outputFolder, unsigned int numJobs, int verb
           }
 
           struct timeval now;
+          procOps->now(&now);
           double durationMS=timeval_diff(&now, &(jobs[i].startupTime)) - jobs[i].startAfterMS;
           if(resultsFile != NULL)
             fprintf(resultsFile, "%s;%s;%d;%d;%d;%f\n", jobs[i].alias, jobs[i].command, (int) wExitStatus, killed[i], (int) shmChildStates[i], durationMS);
+          if(binaryResults)
+            addBinResult(&binResults, i, (int) wExitStatus, killed[i], shmChildStates[i], durationMS);
+          metricsFinished(durationMS, killed[i], shmChildStates[i], (int) wExitStatus);
         }
         else if(w == -1) {
           fprintf (stderr, "Bug: job [%s] with pid [%d] has already finished\n", jobs[i].alias, jobs[i].pid);
@@ -172,12 +303,12 @@ void waitForJobs(bgjob *jobs, char *outputFolder, unsigned int numJobs, int verb
           // Timeout just applies if maxDurationMS is not 0
           if(jobs[i].maxDurationMS != 0) {
             struct timeval now;
-            gettimeofday(&now, NULL);
+            procOps->now(&now);
             if(timeval_diff(&now, &(jobs[i].startupTime)) > jobs[i].maxDurationMS + jobs[i].startAfterMS ) {
               sprintf(MSGBUFF, "Job [%s]: has been running more than [%u] ms. Let's kill it", jobs[i].alias, jobs[i].maxDurationMS);
               tPrint(MSGBUFF);
               fflush(stdout);
-              kill(jobs[i].pid, SIGKILL);
+              procOps->kill(jobs[i].pid);
               killed[i] = 1;
             }
           }
@@ -187,13 +318,14 @@ void waitForJobs(bgjob *jobs, char *outputFolder, unsigned int numJobs, int verb
         finishedJobs++;
       }
     }
+    metricsTick(jobs, numJobs, finishedJobs == numJobs);
     if(finishedJobs == numJobs) {
       if(verbose) {
         sprintf(MSGBUFF, "All jobs finished. Results saved at [%s]", outputFilename);
         tPrint(MSGBUFF);
         fflush(stdout);
       }
-      return;
+      break;
     }
 
     if(verbose > 1)
@@ -203,15 +335,21 @@ void waitForJobs(bgjob *jobs, char *outputFolder, unsigned int numJobs, int verb
         tPrint(MSGBUFF);
         fflush(stdout);
       }
-    usleep(sleepTime);
+    procOps->sleep(sleepTime);
     z++;
   }
 
-  if(fclose(resultsFile) != 0) {
+  if(resultsFile != NULL && fclose(resultsFile) != 0) {
     sprintf(MSGBUFF, "ERROR: Can't close the CSV output file with results");
     tPrint(MSGBUFF);
     fflush(stdout);
   }
+  if(binaryResults && closeBinResults(&binResults) != 0) {
+    sprintf(MSGBUFF, "ERROR: Can't close the binary output file with results");
+    tPrint(MSGBUFF);
+    fflush(stdout);
+  }
+  free(killed);
 }
 
 
@@ -224,17 +362,16 @@ unsigned int countLines(char *filename) {
     fprintf (stderr, "Can't read the job descriptor %s\n", filename);
     exit(1);
   }
-  int ch, nol = 0;
+  int ch, prev = '\n', nol = 0;
   
-  do {
-    ch = fgetc(myFile);
+  while ((ch = fgetc(myFile)) != EOF) {
     if(ch == '\n')
       nol++;
-  } while (ch != EOF);
+    prev = ch;
+  }
   
-  // last line doesn't end with a new line,
-  // but there has to be a line at least before the last line
-  if(ch != '\n' && nol != 0) 
+  // last line doesn't end with a new line
+  if(prev != '\n')
       nol++;
   fclose(myFile);
   return nol;
@@ -256,40 +393,183 @@ void printJobFull(bgjob *b) {
 
 
 
-bgjob *loadJobs(char *filename, unsigned int *numJobs, char *envp[], int verbose) {
-  // aprox 10 characters per param , 50 for separators and miliseconds
-  unsigned int maxLineLength = MAX_ALIAS_LEN+PATH_MAX+10*MAX_ARGS+50;
-  char line[maxLineLength];
-  unsigned int numLines;
-  unsigned int id = 0;
+/**
+  * Compiles the regular expression used to parse the lines of the descriptor
+  * @return 0 if ok
+  */
+int compileJobRegex(regex_t *regexCompiled) {
+  // example about C regexp: http://stackoverflow.com/a/11864144/939015
+  return regcomp(regexCompiled, JOB_REGEX, REG_EXTENDED);
+}
+
+
+/**
+  * Parses a line of the job descriptor. It doesn't exit on errors
+  * so that it can be called from the fuzzing harness.
+  * @arg regexCompiled regex got from compileJobRegex
+  * @arg line line without the ending new line, up to MAX_LINE_LEN - 1 chars
+  * @arg b job to be filled, but id
+  * @arg envp parent's environment
+  * @arg verbose verbosity for the job
+  * @arg errorMsg where a description of the error is returned
+  * @return 0 if a job has been parsed, 1 if the line has to be skipped,
+  *         -1 on error
+  */
+int parseJobLine(regex_t *regexCompiled, char *line, bgjob *b, char *envp[], int verbose, char **errorMsg) {
   char alias[MAX_ALIAS_LEN];
-  unsigned int startAfterMS;
-  unsigned int maxDurationMS;
+  unsigned int startAfterMS  = 0;
+  unsigned int maxDurationMS = 0;
   char command[PATH_MAX];
-  bgjob *b;
-  char *regexString = "([^;]+);([^;]+);([^;]+);([^;]+)"; // startAfterMS
-//char *regexString = "([^;]+);([^;]+);([^;]+)";
-  regex_t regexCompiled;
-//size_t maxGroups = 5; // startAfterMS
-  size_t maxGroups = 5;
-  char  *end;
-  float  num;
+  char envSpec[MAX_LINE_LEN];
+  char cwd[PATH_MAX];
+  size_t maxGroups = JOB_REGEX_GROUPS;
   unsigned int g = 0;
-  char sourceCopy[MAX_ALIAS_LEN+PATH_MAX+50 + 1];
+  char sourceCopy[MAX_LINE_LEN];
   regmatch_t groupArray[maxGroups];
+  char *field;
+
+  if(strlen(line) >= MAX_LINE_LEN) {
+    *errorMsg = "Too long line";
+    return -1;
+  }
+  // headers, comments
+  if(*line == '#')
+    return 1;
+  if (regexec(regexCompiled, line, maxGroups, groupArray, 0) != 0)
+    return 1;
+
+  *alias   = '\0';
+  *command = '\0';
+  *envSpec = '\0';
+  *cwd     = '\0';
+  for (g = 0; g < maxGroups; g++) {
+    if (groupArray[g].rm_so == (regoff_t)-1)
+      break;  // No more groups
+
+    strcpy(sourceCopy, line);
+    sourceCopy[groupArray[g].rm_eo] = 0;
+    field = sourceCopy + groupArray[g].rm_so;
+
+    switch (g) {
+    case 1:
+      if(strlen(field) >= MAX_ALIAS_LEN) {
+        *errorMsg = "Too long alias";
+        return -1;
+      }
+      strcpy(alias, field);
+      break;
+    case 2:
+      if(sscanf(field, "%u", &startAfterMS) != 1) {
+        *errorMsg = "Can't read startAfterMS";
+        return -1;
+      }
+      break;
+    case 3:
+      if(sscanf(field, "%u", &maxDurationMS) != 1) {
+        *errorMsg = "Can't read maxDurationMS";
+        return -1;
+      }
+      break;
+    case 4:
+      if(strlen(field) >= PATH_MAX) {
+        *errorMsg = "Too long command";
+        return -1;
+      }
+      strcpy(command, field);
+      break;
+    case 6:
+      strcpy(envSpec, field);
+      break;
+    case 8:
+      if(strlen(field) >= PATH_MAX) {
+        *errorMsg = "Too long working directory";
+        return -1;
+      }
+      strcpy(cwd, field);
+      break;
+    }
+  }
+
+  strcpy(b->alias, alias);
+  b->startAfterMS  = startAfterMS;
+  b->maxDurationMS = maxDurationMS;
+  strcpy(b->command, command);
+  b->state         = UNSTARTED;
+  b->verbose       = verbose;
+  b->envp          = envp;
+  if(*envSpec != '\0') {
+    b->envp = jobEnv(envSpec, envp);
+    if(b->envp == NULL) {
+      *errorMsg = "Can't parse env (it must be a list of NAME=value or -NAME separated by spaces)";
+      return -1;
+    }
+  }
+  b->cwd           = *cwd != '\0' ? jobCwd(cwd) : NULL;
+  return 0;
+}
+
+
+/**
+  * Reads and parses the lines of a job descriptor. It doesn't exit on errors
+  * so that it can be called from the fuzzing harness.
+  * @arg f job descriptor
+  * @arg regexCompiled regex got from compileJobRegex
+  * @arg jobs array of maxJobs jobs to be filled
+  * @arg numJobs where the number of parsed jobs is returned
+  * @arg line buffer of MAX_LINE_LEN chars, on error it has the wrong line
+  * @arg errorMsg where a description of the error is returned
+  * @return 0 if ok, -1 on a wrong line, -2 if there are more than maxJobs jobs
+  */
+int readJobs(FILE *f, regex_t *regexCompiled, bgjob *jobs, unsigned int maxJobs, unsigned int *numJobs, char *envp[], int verbose, char *line, char **errorMsg) {
+  unsigned int id = 0;
+  char scanfFormat[20];
+  int ch;
+
+  *numJobs = 0;
+  sprintf(scanfFormat, "%%%d[^\n]", MAX_LINE_LEN - 1);
+//printf("scanfFormat=[%s]\n", scanfFormat);
+  // blank lines and leading white spaces are skipped
+  while(fscanf(f, " ") == 0 && fscanf(f, scanfFormat, line) == 1) {
+    // a longer line has been truncated, it mustn't be parsed as another one
+    ch = fgetc(f);
+    if(ch != '\n' && ch != EOF) {
+      *errorMsg = "Too long line";
+      return -1;
+    }
+    if(id >= maxJobs) {
+      *errorMsg = "Bug: more jobs than lines";
+      return -2;
+    }
+    switch(parseJobLine(regexCompiled, line, jobs + id, envp, verbose, errorMsg)) {
+    case 0:
+      jobs[id].id = id;
+      id++;
+      *numJobs = id;
+      break;
+    case -1:
+      return -1;
+    }
+  }
+  return 0;
+}
+
+
+bgjob *loadJobs(char *filename, unsigned int *numJobs, char *envp[], int verbose) {
+  char line[MAX_LINE_LEN];
+  unsigned int numLines;
+  regex_t regexCompiled;
   char MSGBUFF[BUFSIZE];
   bgjob* jobs;
-  char scanfFormat[20];
+  char *errorMsg;
 
   if(verbose > 1) {
-    sprintf(MSGBUFF, "Using regexp [%s] and [%d] max line length when parsing the job descriptor [%s]", regexString, maxLineLength, filename);
+    sprintf(MSGBUFF, "Using regexp [%s] and [%d] max line length when parsing the job descriptor [%s]", JOB_REGEX, MAX_LINE_LEN - 1, filename);
     tPrint(MSGBUFF);
   }
 
-  // example about C regexp: http://stackoverflow.com/a/11864144/939015
   // build regex
-  if (regcomp(&regexCompiled, regexString, REG_EXTENDED)) {
-    fprintf(stderr, "Can't compile regular expression [%s]\n", regexString);
+  if (compileJobRegex(&regexCompiled)) {
+    fprintf(stderr, "Can't compile regular expression [%s]\n", JOB_REGEX);
     exit(1);
   }
 
@@ -302,70 +582,22 @@ bgjob *loadJobs(char *filename, unsigned int *numJobs, char *envp[], int verbose
   jobs = (bgjob*) malloc(numLines * sizeof(bgjob));
 
   FILE* myFile = fopen(filename, "r");
+  if(myFile == NULL) {
+    fprintf (stderr, "Can't read the job descriptor %s\n", filename);
+    exit(1);
+  }
 
-  sprintf(scanfFormat, "%%%d[^\n]\n", maxLineLength - 1);
-//printf("scanfFormat=[%s]\n", scanfFormat);
-  while(fscanf(myFile, scanfFormat, line) == 1) {
-    // headers, comments
-    if(*line == '#')
-      continue;
-
-    if (regexec(&regexCompiled, line, maxGroups, groupArray, 0) == 0) {
-      *alias             = '\0';
-      startAfterMS  = 0;
-      maxDurationMS = 0;
-      *command           = '\0';
-      for (g = 0; g < maxGroups; g++) {
-        if (groupArray[g].rm_so == (size_t)-1)
-          break;  // No more groups
-  
-        strcpy(sourceCopy, line);
-        sourceCopy[groupArray[g].rm_eo] = 0;
-  
-        switch (g) {
-        case 1:
-          strcpy(alias, sourceCopy + groupArray[g].rm_so);
-          if(*alias == '\0') {
-            fprintf(stderr, "Can't parse alias in line [%s] on descriptor %s\n", line, filename);
-            exit(1);
-          }
-          break;
-        case 2:
-          if(sscanf(sourceCopy + groupArray[g].rm_so, "%u", &startAfterMS) != 1) {
-            fprintf(stderr, "Can't read startAfterMS in line [%s] on descriptor %s\n", line, filename);
-            exit(1);
-          }
-          break;
-        case 3:
-          if(sscanf(sourceCopy + groupArray[g].rm_so, "%u", &maxDurationMS) != 1) {
-            fprintf(stderr, "Can't read maxDurationMS in line [%s] on descriptor %s\n", line, filename);
-            exit(1);
-          }
-          break;
-        case 4:
-          strcpy(command, sourceCopy + groupArray[g].rm_so);
-          if(*command == '\0') {
-            fprintf(stderr, "Can't parse command in line [%s] on descriptor %s\n", line, filename);
-            exit(1);
-          }
-          break;
-        }
-      }
-      b                = jobs + id;
-      b->id            = id;
-      strcpy(b->alias, alias);
-      b->startAfterMS  = startAfterMS;
-      b->maxDurationMS = maxDurationMS;
-      strcpy(b->command, command);
-      b->state         = UNSTARTED;
-      b->verbose       = verbose;
-      b->envp          = envp;
-      id++;
-    }
+  if(readJobs(myFile, &regexCompiled, jobs, numLines, numJobs, envp, verbose, line, &errorMsg) != 0) {
+    fprintf(stderr, "%s in line [%s] on descriptor %s\n", errorMsg, line, filename);
+    exit(1);
   }
   
+  if(verbose > 1) {
+    sprintf(MSGBUFF, "%u distinct environments built for the jobs", numJobEnvs());
+    tPrint(MSGBUFF);
+  }
+  regfree(&regexCompiled);
   fclose(myFile);
-  *numJobs = id;
   return jobs;
 }
 
@@ -388,6 +620,8 @@ void launchJob(void *arg, char *shmChildState, char *outputFolder) {
   // we must flush or the buffered output will be printed twice
   fflush(stdout);
   fflush(stderr);
+  struct timeval beforeFork;
+  gettimeofday(&beforeFork, NULL);
   pid = fork();
 
   if (pid < 0) {
@@ -462,7 +696,6 @@ void launchJob(void *arg, char *shmChildState, char *outputFolder) {
 
     char *args[MAX_ARGS+2]; // +1 for executable , +1 for the ending zero
     int numArgs = split(job->command, args, " ", MAX_ARGS + 1); // +1 for exec
-    args[numArgs] = '\0'; // zero ended array of char*
     if(numArgs == -1) {
       *shmChildState = STATE_EXEC_ERROR;
       fprintf(stderr,
@@ -471,6 +704,7 @@ void launchJob(void *arg, char *shmChildState, char *outputFolder) {
         job->alias, job->command, MAX_ARGS);
       exit(1);
     }
+    args[numArgs] = '\0'; // zero ended array of char*
 
     if(job->verbose > 1) {
       sprintf(MSGBUFF,
@@ -484,6 +718,15 @@ void launchJob(void *arg, char *shmChildState, char *outputFolder) {
       }
     }
 
+    // after opening the output files, as outputFolder may be relative
+    if(job->cwd != NULL && chdir(job->cwd) != 0) {
+      *shmChildState = STATE_EXEC_ERROR;
+      fprintf(stderr,
+        "Job [%s]: Can't change to the working directory [%s]\n",
+        job->alias, job->cwd);
+      exit(1);
+    }
+
 //  execl(job->command, job->command, (char *) NULL);
     execve(args[0], args, job->envp);
 
@@ -502,6 +745,7 @@ void launchJob(void *arg, char *shmChildState, char *outputFolder) {
     job->pid         = pid;
     job->state       = STARTED;
     job->startupTime = now;
+    metricsLaunch(timeval_diff(&now, &beforeFork));
 
     if(job->verbose > 1) {
       sprintf(MSGBUFF, "Job [%s]: parent after exec", job->alias);
@@ -511,7 +755,7 @@ void launchJob(void *arg, char *shmChildState, char *outputFolder) {
 }
 
 
-void launchJobs(char *filename, char *outputFolder, char *envp[], int verbose) {
+void launchJobs(char *filename, char *outputFolder, char *envp[], int verbose, int binaryResults, char *metricsFile) {
   unsigned int numJobs;
   bgjob* jobs;
   char MSGBUFF[BUFSIZE];
@@ -521,6 +765,9 @@ void launchJobs(char *filename, char *outputFolder, char *envp[], int verbose) {
   shmChildStates = mmap(NULL, numJobs * sizeof(char), PROT_READ | PROT_WRITE, 
                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
 
+  if(metricsFile != NULL)
+    metricsInit(metricsFile);
+
   if(verbose) {
     printf("%u jobs described on %s:\n", numJobs, filename);
     for(int i = 0; i < numJobs; i++) {
@@ -538,7 +785,8 @@ void launchJobs(char *filename, char *outputFolder, char *envp[], int verbose) {
       sprintf(MSGBUFF, "Let's work with the job [%s] from pid [%u]", jobs[i].alias, getpid());
       tPrint(MSGBUFF);
     }
-    launchJob(&(jobs[i]), &(shmChildStates[i]), outputFolder);
+    procOps->launch(&(jobs[i]), &(shmChildStates[i]), outputFolder);
+    metricsTick(jobs, numJobs, 0);
     if(verbose > 1) {
       sprintf(MSGBUFF, "The job [%s] has been launched from pid [%u]", jobs[i].alias, getpid());
       tPrint(MSGBUFF);
@@ -546,8 +794,9 @@ void launchJobs(char *filename, char *outputFolder, char *envp[], int verbose) {
 
   }
 
-  waitForJobs(jobs, outputFolder, numJobs, verbose);
+  waitForJobs(jobs, outputFolder, numJobs, verbose, binaryResults);
   munmap(shmChildStates, numJobs * sizeof(char));
   free(jobs);
+  freeJobEnvs();
 }
 
@@ -0,0 +1,154 @@
+/*
+ * Background jobs runner fuzzing harness for the job descriptor parser
+ *
+ * It reads the input with readJobs, the reading loop of loadJobs, and checks
+ * that the parsed jobs fit on their fixed-size fields, that their environments
+ * are well formed, that their commands can be splitted like launchJob does
+ * and that countLines never counts less lines than jobs are parsed.
+ *
+ * "make fuzz" builds it for libFuzzer (it needs clang).
+ * "make fuzz-standalone" builds it reading each input from the files given
+ * as arguments or from stdin, to replay crashes or to be used with AFL:
+ *   make fuzz-standalone CC=afl-clang-fast
+ *   afl-fuzz -i in -o out -- ./bgrunner-fuzz @@
+ *
+ * Sources: https://github.com/zoquero/bgrunner/
+ *
+ * @since 20261019
+ * @author zoquero@gmail.com
+ */
+
+#include <stdio.h>        // fprintf
+#include <stdlib.h>       // malloc, abort
+#include <string.h>       // strchr
+#include <stdint.h>       // uint8_t
+#include <unistd.h>       // pwrite, ftruncate
+
+#include "bgrunner.h"
+
+
+#define CHECK(cond) \
+  if(!(cond)) { \
+    fprintf(stderr, "Property failed at %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+    abort(); \
+  }
+
+static regex_t regexCompiled;
+static char    tmpFilename[] = "/tmp/bgrunner-fuzz.XXXXXX";
+static int     tmpFd = -1;
+static char   *fakeEnvp[] = { "PATH=/usr/bin:/bin", "HOME=/root", "LANG=C", NULL };
+
+
+static void fuzzInit() {
+  if(compileJobRegex(&regexCompiled)) {
+    fprintf(stderr, "Can't compile regular expression [%s]\n", JOB_REGEX);
+    exit(1);
+  }
+  // countLines reads a file, so the input is written on this one
+  tmpFd = mkstemp(tmpFilename);
+  if(tmpFd < 0) {
+    fprintf(stderr, "Can't create the temporary file %s\n", tmpFilename);
+    exit(1);
+  }
+  unlink(tmpFilename);
+  sprintf(tmpFilename, "/proc/self/fd/%d", tmpFd);
+}
+
+
+static void checkJob(bgjob *b) {
+  char  commandCopy[PATH_MAX];
+  char *args[MAX_ARGS + 2];
+  int   numArgs;
+
+  CHECK(*b->alias != '\0' && strlen(b->alias) < MAX_ALIAS_LEN);
+  CHECK(*b->command != '\0' && strlen(b->command) < PATH_MAX);
+  CHECK(b->state == UNSTARTED);
+  CHECK(b->cwd == NULL || (*b->cwd != '\0' && strlen(b->cwd) < PATH_MAX));
+  CHECK(b->envp != NULL);
+  for(int i = 0; b->envp[i] != NULL; i++)
+    CHECK(strchr(b->envp[i], '=') != NULL && *b->envp[i] != '=');
+
+  strcpy(commandCopy, b->command);
+  numArgs = split(commandCopy, args, " ", MAX_ARGS + 1);
+  CHECK(numArgs >= -1 && numArgs <= MAX_ARGS + 1);
+}
+
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  FILE *f;
+  char  line[MAX_LINE_LEN];
+  char *errorMsg;
+  unsigned int numLines;
+  unsigned int numJobs;
+  bgjob *jobs;
+
+  if(tmpFd < 0)
+    fuzzInit();
+
+  if(ftruncate(tmpFd, 0) != 0 || pwrite(tmpFd, data, size, 0) != size) {
+    fprintf(stderr, "Can't write the temporary file %s\n", tmpFilename);
+    exit(1);
+  }
+  numLines = countLines(tmpFilename);
+
+  // fmemopen can't open an empty buffer
+  if(size == 0)
+    return 0;
+  // sized like loadJobs does, readJobs reports if there are more jobs
+  jobs = malloc((numLines + 1) * sizeof(bgjob));
+  f    = fmemopen((void *) data, size, "r");
+  if(jobs == NULL || f == NULL) {
+    free(jobs);
+    return 0;
+  }
+
+  CHECK(readJobs(f, &regexCompiled, jobs, numLines, &numJobs, fakeEnvp, 0, line, &errorMsg) != -2);
+  CHECK(numJobs <= numLines);
+  for(unsigned int i = 0; i < numJobs; i++) {
+    CHECK(jobs[i].id == i);
+    checkJob(jobs + i);
+  }
+
+  fclose(f);
+  freeJobEnvs();
+  free(jobs);
+  return 0;
+}
+
+
+#ifdef BGRUNNER_FUZZ_STANDALONE
+static void runFile(FILE *f) {
+  size_t size = 0, cap = 4096, n;
+  uint8_t *data = malloc(cap);
+
+  while(data != NULL && (n = fread(data + size, 1, cap - size, f)) > 0) {
+    size += n;
+    if(size == cap)
+      data = realloc(data, cap *= 2);
+  }
+  if(data == NULL) {
+    fprintf(stderr, "Can't allocate memory for the input\n");
+    exit(1);
+  }
+  LLVMFuzzerTestOneInput(data, size);
+  free(data);
+}
+
+
+int main(int argc, char *argv[]) {
+  if(argc < 2) {
+    runFile(stdin);
+    return 0;
+  }
+  for(int i = 1; i < argc; i++) {
+    FILE *f = fopen(argv[i], "r");
+    if(f == NULL) {
+      fprintf(stderr, "Can't read %s\n", argv[i]);
+      return 1;
+    }
+    runFile(f);
+    fclose(f);
+  }
+  return 0;
+}
+#endif
@@ -0,0 +1,236 @@
+/*
+ * Background jobs runner metrics exporter
+ *
+ * Writes the metrics in the Prometheus text format
+ * so that they can be scraped by the textfile collector of node_exporter.
+ *
+ * Sources: https://github.com/zoquero/bgrunner/
+ *
+ * @since 20261019
+ * @author zoquero@gmail.com
+ */
+
+#include <stdio.h>        // snprintf, vsnprintf, rename
+#include <stdarg.h>       // va_list
+#include <stdlib.h>       // exit
+#include <string.h>       // strlen
+#include <unistd.h>       // write, close
+#include <fcntl.h>        // open
+#include <sys/time.h>     // struct timeval
+
+#include "bgrunner.h"
+
+
+/* Upper bounds (in seconds) of the buckets of the histograms, +Inf aside */
+static const double durationBuckets[] = {
+  0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1, 5, 10, 30, 60, 300, 900, 3600
+};
+static const double launchBuckets[] = {
+  0.00001, 0.00005, 0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5
+};
+#define NUM_DURATION_BUCKETS (sizeof(durationBuckets) / sizeof(double))
+#define NUM_LAUNCH_BUCKETS   (sizeof(launchBuckets) / sizeof(double))
+
+/** Histogram with fixed buckets. counts[] aren't cumulative, +Inf is the last one.
+ *  It's sized for the histogram with more buckets. */
+typedef struct {
+  unsigned long  counts[NUM_DURATION_BUCKETS + 1];
+  unsigned long  count;
+  double         sum;
+} bghistogram;
+
+/** Counters and histograms, the gauges are computed from the jobs when writing */
+typedef struct {
+  char           filename[PATH_MAX];
+  char           tmpFilename[PATH_MAX];
+  struct timeval lastWrite;
+  unsigned long  launches;
+  unsigned long  failures;
+  unsigned long  timeouts;
+  unsigned long  execErrors;
+  bghistogram    duration;
+  bghistogram    launch;
+} bgmetrics;
+
+/* Metrics of this run, static like shmChildStates. NULL if disabled */
+static bgmetrics *metrics;
+static bgmetrics  metricsStorage;
+
+
+static void observe(bghistogram *h, const double *buckets, size_t numBuckets, double value) {
+  size_t b = 0;
+  while(b < numBuckets && value > buckets[b])
+    b++;
+  h->counts[b]++;
+  h->count++;
+  h->sum += value;
+}
+
+
+/**
+  * Enables the metrics exporter
+  * @arg filename metrics file, it's replaced atomically on every write
+  */
+void metricsInit(char *filename) {
+  metrics = &metricsStorage;
+  memset(metrics, 0, sizeof(bgmetrics));
+  snprintf(metrics->filename, PATH_MAX, "%s", filename);
+  if(snprintf(metrics->tmpFilename, PATH_MAX, "%s.tmp", filename) >= PATH_MAX) {
+    fprintf(stderr, "Too long metrics filename %s\n", filename);
+    exit(1);
+  }
+}
+
+
+/**
+  * Accounts a job launch
+  * @arg latencyMS time spent by the parent forking the job
+  */
+void metricsLaunch(double latencyMS) {
+  if(metrics == NULL)
+    return;
+  metrics->launches++;
+  observe(&metrics->launch, launchBuckets, NUM_LAUNCH_BUCKETS, latencyMS / 1000);
+}
+
+
+/**
+  * Accounts a finished job
+  * @arg durationMS duration of the job
+  * @arg killed 1 if it has been killed by timeout
+  * @arg execResult EXEC_RESULT_OK or EXEC_RESULT_ERROR
+  * @arg retCode return code of the job
+  */
+void metricsFinished(double durationMS, short killed, char execResult, int retCode) {
+  if(metrics == NULL)
+    return;
+  if(killed)
+    metrics->timeouts++;
+  else if(execResult == EXEC_RESULT_ERROR)
+    metrics->execErrors++;
+  else if(retCode != 0)
+    metrics->failures++;
+  observe(&metrics->duration, durationBuckets, NUM_DURATION_BUCKETS, durationMS / 1000);
+}
+
+
+/**
+  * Appends to the n chars already written on buf, like snprintf
+  * @return the new length, or len if it doesn't fit
+  */
+static size_t append(char *buf, size_t len, size_t n, const char *format, ...) {
+  va_list ap;
+  int     r;
+
+  if(n >= len)
+    return len;
+  va_start(ap, format);
+  r = vsnprintf(buf + n, len - n, format, ap);
+  va_end(ap);
+  if(r < 0 || (size_t) r >= len - n)
+    return len;
+  return n + r;
+}
+
+
+static size_t printHistogram(char *buf, size_t len, size_t n, char *name, char *help, bghistogram *h, const double *buckets, size_t numBuckets) {
+  unsigned long cumulative = 0;
+
+  n = append(buf, len, n, "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+  for(size_t b = 0; b < numBuckets; b++) {
+    cumulative += h->counts[b];
+    n = append(buf, len, n, "%s_bucket{le=\"%g\"} %lu\n", name, buckets[b], cumulative);
+  }
+  return append(buf, len, n, "%s_bucket{le=\"+Inf\"} %lu\n%s_sum %f\n%s_count %lu\n",
+         name, h->count, name, h->sum, name, h->count);
+}
+
+
+/**
+  * Writes the metrics file, replacing it atomically (write + rename)
+  * @return 0 if ok, -1 on error
+  */
+static int metricsWrite(bgjob *jobs, unsigned int numJobs, struct timeval *now) {
+  char buf[METRICS_BUFSIZE];
+  size_t n = 0;
+  unsigned int queued = 0, running = 0, finished = 0;
+  int fd;
+
+  for(int i = 0; i < numJobs; i++) {
+    if(jobs[i].state == UNSTARTED)
+      queued++;
+    else if(jobs[i].state == FINISHED)
+      finished++;
+    else if(timeval_diff(now, &(jobs[i].startupTime)) < jobs[i].startAfterMS)
+      queued++;   // the child still sleeps before running the command
+    else
+      running++;
+  }
+
+  n = append(buf, sizeof(buf), n,
+         "# HELP bgrunner_jobs_queued Jobs not launched yet or waiting for their startAfterMS\n"
+         "# TYPE bgrunner_jobs_queued gauge\n"
+         "bgrunner_jobs_queued %u\n"
+         "# HELP bgrunner_jobs_running Jobs running their command\n"
+         "# TYPE bgrunner_jobs_running gauge\n"
+         "bgrunner_jobs_running %u\n"
+         "# HELP bgrunner_jobs_finished Jobs already finished\n"
+         "# TYPE bgrunner_jobs_finished gauge\n"
+         "bgrunner_jobs_finished %u\n"
+         "# HELP bgrunner_launches_total Jobs forked\n"
+         "# TYPE bgrunner_launches_total counter\n"
+         "bgrunner_launches_total %lu\n"
+         "# HELP bgrunner_failures_total Jobs finished with a return code other than 0\n"
+         "# TYPE bgrunner_failures_total counter\n"
+         "bgrunner_failures_total %lu\n"
+         "# HELP bgrunner_timeouts_total Jobs killed because of their maxDurationMS\n"
+         "# TYPE bgrunner_timeouts_total counter\n"
+         "bgrunner_timeouts_total %lu\n"
+         "# HELP bgrunner_exec_errors_total Jobs which command couldn't be executed\n"
+         "# TYPE bgrunner_exec_errors_total counter\n"
+         "bgrunner_exec_errors_total %lu\n",
+         queued, running, finished, metrics->launches,
+         metrics->failures, metrics->timeouts, metrics->execErrors);
+  n = printHistogram(buf, sizeof(buf), n, "bgrunner_job_duration_seconds",
+         "Duration of the finished jobs", &metrics->duration,
+         durationBuckets, NUM_DURATION_BUCKETS);
+  n = printHistogram(buf, sizeof(buf), n, "bgrunner_launch_latency_seconds",
+         "Time spent forking the jobs", &metrics->launch,
+         launchBuckets, NUM_LAUNCH_BUCKETS);
+  if(n == sizeof(buf))
+    return -1;  // truncated
+
+  fd = open(metrics->tmpFilename, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  if(fd < 0)
+    return -1;
+  if(write(fd, buf, n) != n) {
+    close(fd);
+    return -1;
+  }
+  if(close(fd) != 0)
+    return -1;
+  return rename(metrics->tmpFilename, metrics->filename);
+}
+
+
+/**
+  * Writes the metrics file if METRICS_INTERVAL_US has elapsed since
+  * the last write, or always if force is set.
+  * It's cheap to call on every iteration of the scheduler loop.
+  */
+void metricsTick(bgjob *jobs, unsigned int numJobs, int force) {
+  struct timeval now;
+  char MSGBUFF[BUFSIZE];
+
+  if(metrics == NULL)
+    return;
+  clockNow(&now);
+  if(!force && timeval_diff(&now, &metrics->lastWrite) * 1000 < METRICS_INTERVAL_US)
+    return;
+  metrics->lastWrite = now;
+  if(metricsWrite(jobs, numJobs, &now) != 0) {
+    snprintf(MSGBUFF, sizeof(MSGBUFF), "ERROR: Can't write the metrics file %s", metrics->filename);
+    tPrint(MSGBUFF);
+    fflush(stdout);
+  }
+}
@@ -0,0 +1,400 @@
+/*
+ * Background jobs runner binary results file and report
+ *
+ * Sources: https://github.com/zoquero/bgrunner/
+ *
+ * @since 20261019
+ * @author zoquero@gmail.com
+ */
+
+#include <stdio.h>        // printf, fprintf
+#include <stdlib.h>       // malloc, qsort
+#include <string.h>       // strlen, memcpy
+#include <unistd.h>       // ftruncate, close
+#include <fcntl.h>        // open
+#include <sys/mman.h>     // mmap
+#include <sys/stat.h>     // fstat
+
+#include "bgrunner.h"
+
+
+/* Durations used by the comparator when sorting rows */
+static double *sortDurations;
+
+/** Aggregates of the jobs which alias share the same prefix */
+typedef struct {
+  char           prefix[MAX_ALIAS_LEN];
+  unsigned int   jobs;
+  unsigned int   failures;
+  unsigned int   timeouts;
+  unsigned int   execErrors;
+} bgprefixstats;
+
+
+/**
+  * Rounds up to a multiple of 8 so that every column stays aligned
+  */
+static size_t align8(size_t n) {
+  return (n + 7) & ~((size_t) 7);
+}
+
+
+/**
+  * Total size of a binary results file and offset of its string table
+  * @arg numJobs capacity of the columns
+  * @arg strTableSize size of the string table
+  * @arg strTableOffset where the offset of the string table will be stored
+  * @return size of the file
+  */
+static size_t binResultsLayout(uint32_t numJobs, uint64_t strTableSize, size_t *strTableOffset) {
+  size_t off = sizeof(bgresheader);
+  off += numJobs * sizeof(double);                      // durationMS
+  off += numJobs * (2 * sizeof(uint32_t) + 2);          // jobId, retCode, killed, execResult
+  off  = align8(off);
+  off += numJobs * 2 * sizeof(uint32_t);                // aliasOff, commandOff
+  *strTableOffset = off;
+  return off + strTableSize;
+}
+
+
+/**
+  * Sets the column pointers of a results file already mapped on r->map
+  */
+static void binResultsColumns(bgresults *r) {
+  uint32_t n = r->header->numJobs;
+  char *p    = r->map + sizeof(bgresheader);
+
+  r->durationMS = (double *) p;   p += n * sizeof(double);
+  r->jobId      = (uint32_t *) p; p += n * sizeof(uint32_t);
+  r->retCode    = (int32_t *) p;  p += n * sizeof(int32_t);
+  r->killed     = (uint8_t *) p;  p += n;
+  r->execResult = (uint8_t *) p;  p += n;
+  p = r->map + align8(p - r->map);
+  r->aliasOff   = (uint32_t *) p; p += n * sizeof(uint32_t);
+  r->commandOff = (uint32_t *) p; p += n * sizeof(uint32_t);
+  r->strTable   = p;
+}
+
+
+/**
+  * Creates the binary results file and maps it on memory,
+  * filling the string table with the aliases and commands of the jobs.
+  * @return 0 if ok, -1 on error
+  */
+int openBinResults(bgresults *r, char *filename, bgjob *jobs, unsigned int numJobs, unsigned int sleepTimeUS) {
+  uint64_t strTableSize = 0;
+  size_t   strTableOffset;
+  uint64_t s;
+
+  for(int i = 0; i < numJobs; i++)
+    strTableSize += strlen(jobs[i].alias) + 1 + strlen(jobs[i].command) + 1;
+  if(strTableSize > UINT32_MAX) {
+    fprintf(stderr, "Too many or too long commands for the binary results file\n");
+    return -1;
+  }
+
+  r->size = binResultsLayout(numJobs, strTableSize, &strTableOffset);
+  r->fd   = open(filename, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  if(r->fd < 0)
+    return -1;
+  if(ftruncate(r->fd, r->size) != 0) {
+    close(r->fd);
+    return -1;
+  }
+  r->map = mmap(NULL, r->size, PROT_READ | PROT_WRITE, MAP_SHARED, r->fd, 0);
+  if(r->map == MAP_FAILED) {
+    close(r->fd);
+    return -1;
+  }
+
+  r->header = (bgresheader *) r->map;
+  memcpy(r->header->magic, BIN_RESULTS_MAGIC, sizeof(r->header->magic));
+  r->header->version      = BIN_RESULTS_VERSION;
+  r->header->numJobs      = numJobs;
+  r->header->numRecords   = 0;
+  r->header->sleepTimeUS  = sleepTimeUS;
+  r->header->strTableSize = strTableSize;
+  binResultsColumns(r);
+
+  s = 0;
+  for(int i = 0; i < numJobs; i++) {
+    r->aliasOff[i] = s;
+    strcpy(r->strTable + s, jobs[i].alias);
+    s += strlen(jobs[i].alias) + 1;
+    r->commandOff[i] = s;
+    strcpy(r->strTable + s, jobs[i].command);
+    s += strlen(jobs[i].command) + 1;
+  }
+  return 0;
+}
+
+
+/**
+  * Appends the row of a finished job to the binary results file
+  */
+void addBinResult(bgresults *r, unsigned int jobId, int retCode, short killed, char execResult, double durationMS) {
+  uint32_t row = r->header->numRecords;
+
+  if(row >= r->header->numJobs)
+    return;
+  r->durationMS[row] = durationMS;
+  r->jobId[row]      = jobId;
+  r->retCode[row]    = retCode;
+  r->killed[row]     = killed;
+  r->execResult[row] = execResult;
+  r->header->numRecords = row + 1;
+}
+
+
+/**
+  * Unmaps and closes a binary results file
+  * @return 0 if ok, -1 on error
+  */
+int closeBinResults(bgresults *r) {
+  int ret = 0;
+  if(munmap(r->map, r->size) != 0)
+    ret = -1;
+  if(close(r->fd) != 0)
+    ret = -1;
+  return ret;
+}
+
+
+/**
+  * Maps read-only an existing binary results file, validating its layout
+  * @return 0 if ok, -1 on error
+  */
+int loadBinResults(bgresults *r, char *filename) {
+  struct stat st;
+  size_t strTableOffset;
+
+  r->fd = open(filename, O_RDONLY);
+  if(r->fd < 0) {
+    fprintf(stderr, "Can't open the binary results file %s\n", filename);
+    return -1;
+  }
+  if(fstat(r->fd, &st) != 0 || st.st_size < sizeof(bgresheader)) {
+    fprintf(stderr, "%s is not a binary results file\n", filename);
+    close(r->fd);
+    return -1;
+  }
+  r->size = st.st_size;
+  r->map  = mmap(NULL, r->size, PROT_READ, MAP_SHARED, r->fd, 0);
+  if(r->map == MAP_FAILED) {
+    fprintf(stderr, "Can't map the binary results file %s\n", filename);
+    close(r->fd);
+    return -1;
+  }
+  r->header = (bgresheader *) r->map;
+  if(memcmp(r->header->magic, BIN_RESULTS_MAGIC, sizeof(r->header->magic)) != 0
+      || r->header->version != BIN_RESULTS_VERSION
+      || r->header->numRecords > r->header->numJobs
+      || r->header->strTableSize > UINT32_MAX
+      || binResultsLayout(r->header->numJobs, r->header->strTableSize, &strTableOffset) != r->size) {
+    fprintf(stderr, "%s is not a valid binary results file\n", filename);
+    closeBinResults(r);
+    return -1;
+  }
+  binResultsColumns(r);
+
+  for(uint32_t i = 0; i < r->header->numRecords; i++) {
+    uint32_t j = r->jobId[i];
+    if(j >= r->header->numJobs
+        || r->aliasOff[j] >= r->header->strTableSize
+        || r->commandOff[j] >= r->header->strTableSize) {
+      fprintf(stderr, "Corrupted row [%u] on binary results file %s\n", i, filename);
+      closeBinResults(r);
+      return -1;
+    }
+  }
+  if(r->header->strTableSize > 0 && r->strTable[r->header->strTableSize - 1] != '\0') {
+    fprintf(stderr, "Corrupted string table on binary results file %s\n", filename);
+    closeBinResults(r);
+    return -1;
+  }
+  return 0;
+}
+
+
+/**
+  * Sorts row indexes by descending duration
+  */
+static int cmpRowsByDuration(const void *a, const void *b) {
+  double da = sortDurations[*(const uint32_t *) a];
+  double db = sortDurations[*(const uint32_t *) b];
+  return (da < db) - (da > db);
+}
+
+
+static int cmpPrefixes(const void *a, const void *b) {
+  return strcmp(((const bgprefixstats *) a)->prefix, ((const bgprefixstats *) b)->prefix);
+}
+
+
+/**
+  * Duration at a percentile of the rows sorted by descending duration
+  */
+static double percentile(uint32_t *rows, uint32_t n, double *durations, double p) {
+  uint32_t rank = (uint32_t) (p / 100 * (n - 1) + 0.5);
+  return durations[rows[n - 1 - rank]];
+}
+
+
+/**
+  * Writes the rows of a binary results file as a CSV file
+  * with the same format as RESULTS_BASENAME.
+  * @return 0 if ok, -1 on error
+  */
+static int exportResultsCSV(bgresults *r, char *csvFilename) {
+  FILE *f = fopen(csvFilename, "w");
+  if(f == NULL) {
+    fprintf(stderr, "Can't open the CSV file %s\n", csvFilename);
+    return -1;
+  }
+  fprintf(f, "#job_alias;job_command;wait_ret_code;killedByTimeout(0==false,1==true);execResult(1==ok,2==error);durationMS(sleepTime=%dus)\n", r->header->sleepTimeUS);
+  for(uint32_t i = 0; i < r->header->numRecords; i++) {
+    uint32_t j = r->jobId[i];
+    fprintf(f, "%s;%s;%d;%d;%d;%f\n", r->strTable + r->aliasOff[j], r->strTable + r->commandOff[j], r->retCode[i], r->killed[i], r->execResult[i], r->durationMS[i]);
+  }
+  if(fclose(f) != 0) {
+    fprintf(stderr, "Can't close the CSV file %s\n", csvFilename);
+    return -1;
+  }
+  return 0;
+}
+
+
+/**
+  * Groups the rows by alias prefix using an open addressing hash table
+  * @return array of groups sorted by prefix, to be freed by the caller
+  */
+static bgprefixstats *statsByPrefix(bgresults *r, unsigned int prefixLen, uint32_t *numGroups) {
+  uint32_t n    = r->header->numRecords;
+  size_t   cap  = 16;
+  uint32_t used = 0;
+  bgprefixstats *table;
+
+  // in size_t, 2 * n doesn't fit on an uint32_t with more than 2^31 rows
+  while(cap < 2 * (size_t) n)
+    cap <<= 1;
+  table = calloc(cap, sizeof(bgprefixstats));
+  if(table == NULL) {
+    fprintf(stderr, "Can't allocate memory for the report\n");
+    exit(1);
+  }
+
+  for(uint32_t i = 0; i < n; i++) {
+    char     *alias = r->strTable + r->aliasOff[r->jobId[i]];
+    size_t    len   = strnlen(alias, MAX_ALIAS_LEN - 1);
+    size_t    h;
+    bgprefixstats *g;
+
+    if(len > prefixLen)
+      len = prefixLen;
+    for(h = hashString(alias, len) & (cap - 1); ; h = (h + 1) & (cap - 1)) {
+      g = table + h;
+      if(g->jobs == 0) {
+        memcpy(g->prefix, alias, len);
+        g->prefix[len] = '\0';
+        used++;
+        break;
+      }
+      if(strncmp(g->prefix, alias, len) == 0 && g->prefix[len] == '\0')
+        break;
+    }
+    g->jobs++;
+    if(r->killed[i])
+      g->timeouts++;
+    else if(r->execResult[i] == EXEC_RESULT_ERROR)
+      g->execErrors++;
+    else if(r->retCode[i] != 0)
+      g->failures++;
+  }
+
+  // compact the used slots at the beginning of the table
+  uint32_t k = 0;
+  for(size_t i = 0; i < cap; i++)
+    if(table[i].jobs != 0)
+      table[k++] = table[i];
+  qsort(table, used, sizeof(bgprefixstats), cmpPrefixes);
+  *numGroups = used;
+  return table;
+}
+
+
+/**
+  * Prints aggregates about a binary results file:
+  * duration percentiles, failures and timeouts by alias prefix
+  * and the slowest jobs. Optionally exports it as CSV.
+  * @arg filename binary results file
+  * @arg prefixLen number of characters of the alias to group by
+  * @arg topN number of slowest jobs to show
+  * @arg csvFilename CSV file to export to, or NULL
+  * @return 0 if ok, 1 on error
+  */
+int reportResults(char *filename, unsigned int prefixLen, unsigned int topN, char *csvFilename) {
+  bgresults r;
+  uint32_t  n;
+  uint32_t *rows;
+  uint32_t  numGroups;
+  bgprefixstats *groups;
+  double    sum = 0;
+
+  if(loadBinResults(&r, filename) != 0)
+    return 1;
+  n = r.header->numRecords;
+
+  if(csvFilename != NULL && exportResultsCSV(&r, csvFilename) != 0) {
+    closeBinResults(&r);
+    return 1;
+  }
+
+  printf("%u jobs finished of %u described (sleepTime=%uus)\n", n, r.header->numJobs, r.header->sleepTimeUS);
+  if(n == 0) {
+    closeBinResults(&r);
+    return 0;
+  }
+
+  rows = malloc(n * sizeof(uint32_t));
+  if(rows == NULL) {
+    fprintf(stderr, "Can't allocate memory for the report\n");
+    exit(1);
+  }
+  for(uint32_t i = 0; i < n; i++) {
+    rows[i] = i;
+    sum += r.durationMS[i];
+  }
+  sortDurations = r.durationMS;
+  qsort(rows, n, sizeof(uint32_t), cmpRowsByDuration);
+
+  printf("\nDuration (ms):\n");
+  printf("  min=%f mean=%f max=%f\n", r.durationMS[rows[n - 1]], sum / n, r.durationMS[rows[0]]);
+  printf("  p50=%f p90=%f p95=%f p99=%f p99.9=%f\n",
+    percentile(rows, n, r.durationMS, 50), percentile(rows, n, r.durationMS, 90),
+    percentile(rows, n, r.durationMS, 95), percentile(rows, n, r.durationMS, 99),
+    percentile(rows, n, r.durationMS, 99.9));
+
+  groups = statsByPrefix(&r, prefixLen, &numGroups);
+  printf("\nBy alias prefix of %u characters:\n", prefixLen);
+  printf("  %-20s %10s %10s %10s %10s\n", "#prefix", "jobs", "failures", "timeouts", "execErrors");
+  for(uint32_t i = 0; i < numGroups; i++)
+    printf("  %-20s %10u %10u %10u %10u\n", groups[i].prefix,
+      groups[i].jobs, groups[i].failures, groups[i].timeouts, groups[i].execErrors);
+  free(groups);
+
+  if(topN > n)
+    topN = n;
+  printf("\nTop %u slowest jobs:\n", topN);
+  for(uint32_t i = 0; i < topN; i++) {
+    uint32_t row = rows[i];
+    uint32_t j   = r.jobId[row];
+    printf("  %f ms [%s] [%s] retCode=[%d] killed=[%d] execResult=[%d]\n",
+      r.durationMS[row], r.strTable + r.aliasOff[j], r.strTable + r.commandOff[j],
+      r.retCode[row], r.killed[row], r.execResult[row]);
+  }
+
+  free(rows);
+  if(closeBinResults(&r) != 0)
+    return 1;
+  return 0;
+}
@@ -0,0 +1,186 @@
+/*
+ * Background jobs runner simulation mode
+ *
+ * Runs the scheduler with a fake clock and fake child processes, so that
+ * the timeout, delay and ordering semantics can be checked with huge
+ * descriptors in a moment. The command of each job describes its fake child:
+ *
+ *   <durationMS> (<returnCode>)
+ *
+ * and any other command behaves like a failed execve. Sleeping doesn't wait:
+ * the clock jumps to the first poll of the scheduler after the next child
+ * exit or timeout, so idle polls are skipped but the results are the same.
+ *
+ * Sources: https://github.com/zoquero/bgrunner/
+ *
+ * @since 20261019
+ * @author zoquero@gmail.com
+ */
+
+#include <stdio.h>        // fprintf
+#include <stdlib.h>       // realloc, strtoul
+#include <string.h>       // strcpy
+#include <errno.h>        // errno
+#include <limits.h>       // UINT_MAX
+#include <ctype.h>        // isdigit
+#include <signal.h>       // SIGKILL
+#include <sys/wait.h>     // W_EXITCODE
+
+#include "bgrunner.h"
+
+
+/** Fake child process, its pid is its index + 1 */
+typedef struct {
+  double         exitMS;
+  int            status;
+  short          reaped;
+  short          killed;
+} bgsimchild;
+
+static unsigned long long simClockUS;
+static bgsimchild  *children;
+static unsigned int numChildren;
+static unsigned int capChildren;
+static bgtimers     exits;          // exits of the children, maybe outdated
+static bgtimers     deadlines;      // timeouts of the children, to skip idle polls
+
+
+static void simNow(struct timeval *now) {
+  now->tv_sec  = simClockUS / 1000000;
+  now->tv_usec = simClockUS % 1000000;
+}
+
+
+static double simNowMS() {
+  return (double) simClockUS / 1000;
+}
+
+
+/**
+  * Launches a fake child for a job, like launchJob
+  */
+static void simLaunch(void *arg, char *shmChildState, char *outputFolder) {
+  bgjob *job = (bgjob *) arg;
+  char   commandCopy[PATH_MAX];
+  char  *args[3];
+  char  *end;
+  unsigned long durationMS = 0;
+  long   retCode = 0;
+  int    execOk;
+  bgsimchild *c;
+
+  if(numChildren == capChildren) {
+    capChildren = capChildren ? 2 * capChildren : 1024;
+    children    = realloc(children, capChildren * sizeof(bgsimchild));
+    if(children == NULL) {
+      fprintf(stderr, "Can't allocate memory for the simulated jobs\n");
+      exit(1);
+    }
+  }
+  c = children + numChildren;
+
+  strcpy(commandCopy, job->command);
+  int numArgs = split(commandCopy, args, " ", 2);
+  execOk = numArgs >= 1;
+  // an integer number of miliseconds that fits on an unsigned int,
+  // like startAfterMS and maxDurationMS
+  if(execOk) {
+    errno = 0;
+    durationMS = strtoul(args[0], &end, 10);
+    execOk = isdigit((unsigned char) *args[0]) && *end == '\0'
+             && errno == 0 && durationMS <= UINT_MAX;
+  }
+  if(execOk && numArgs == 2) {
+    errno = 0;
+    retCode = strtol(args[1], &end, 10);
+    execOk = *end == '\0' && errno == 0;
+  }
+
+  if(!execOk)
+    durationMS = 0;  // exits as soon as it would call execve
+  *shmChildState   = execOk ? STATE_FORKED : STATE_EXEC_ERROR;
+  job->pid         = numChildren + 1;
+  job->state       = STARTED;
+  simNow(&job->startupTime);
+  c->exitMS = simNowMS() + job->startAfterMS + durationMS;
+  c->status = W_EXITCODE(execOk ? (int) (retCode & 0xff) : 1, 0);
+  c->reaped = 0;
+  c->killed = 0;
+  timerPush(&exits, c->exitMS, numChildren);
+  if(job->maxDurationMS != 0)
+    timerPush(&deadlines, simNowMS() + job->startAfterMS + job->maxDurationMS, numChildren);
+  numChildren++;
+  metricsLaunch(0);
+}
+
+
+/**
+  * Reaps a fake child if it has already exited, like waitpid(pid, , WNOHANG)
+  */
+static pid_t simReap(pid_t pid, int *status) {
+  bgsimchild *c;
+
+  if(pid < 1 || pid > numChildren || children[pid - 1].reaped)
+    return -1;
+  c = children + pid - 1;
+  if(c->exitMS > simNowMS())
+    return 0;
+  c->reaped = 1;
+  *status   = c->status;
+  return pid;
+}
+
+
+static int simKill(pid_t pid) {
+  bgsimchild *c;
+
+  if(pid < 1 || pid > numChildren || children[pid - 1].reaped)
+    return -1;
+  c = children + pid - 1;
+  c->killed = 1;
+  c->exitMS = simNowMS();
+  c->status = W_EXITCODE(0, SIGKILL);
+  timerPush(&exits, c->exitMS, pid - 1);
+  return 0;
+}
+
+
+/**
+  * Advances the clock to the first poll after the next exit or timeout
+  */
+static void simSleep(unsigned int us) {
+  double next = -1;
+  unsigned long long nextUS;
+  unsigned long long steps = 1;
+
+  // forget the exits and timeouts that can't happen anymore
+  while(exits.size > 0 && (children[exits.items[0].id].reaped
+      || children[exits.items[0].id].exitMS != exits.items[0].atMS))
+    timerPop(&exits);
+  while(deadlines.size > 0 && (children[deadlines.items[0].id].reaped
+      || children[deadlines.items[0].id].killed))
+    timerPop(&deadlines);
+
+  if(exits.size > 0)
+    next = exits.items[0].atMS;
+  if(deadlines.size > 0 && (next < 0 || deadlines.items[0].atMS < next))
+    next = deadlines.items[0].atMS;
+  if(next >= 0) {
+    nextUS = (unsigned long long) (next * 1000 + 0.5);
+    if(nextUS > simClockUS + us)
+      steps = (nextUS - simClockUS + us - 1) / us;
+  }
+  simClockUS += steps * us;
+}
+
+
+static bgprocops simOps = { simLaunch, simReap, simKill, simNow, simSleep };
+
+
+/**
+  * Enables the simulation mode
+  */
+void simulate() {
+  simClockUS = 0;
+  setProcOps(&simOps);
+}